@@ -6,9 +6,164 @@
 #include <conio.h>
 #include <exception>
 #include <stdexcept>
+#ifdef MEMORY_PROFILE
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <iomanip>
+#endif
 
 using namespace std;
 
+#ifdef MEMORY_PROFILE
+// Memory profiling mode (compile with -DMEMORY_PROFILE)
+// Each heap allocation is counted twice: as "self" against the innermost
+// active MEM_REGION, and as "incl" against every region on the scope stack.
+// So a getter copy made while saving shows up as self in "getters" and as
+// incl in the save region that called it. Frees are charged back to the
+// region that made the allocation, so "live" is what that region still holds.
+// The "program" region is always active: its self row is unscoped code and
+// its incl row is the whole program. Not thread-safe.
+enum MemRegion {
+    REGION_PROGRAM,
+    REGION_LOAD_STUDENTS,
+    REGION_LOAD_INSTRUCTORS,
+    REGION_LOAD_COURSES,
+    REGION_MENUS,
+    REGION_GETTERS,
+    REGION_GRADES,
+    REGION_SAVE_STUDENTS,
+    REGION_SAVE_INSTRUCTORS,
+    REGION_SAVE_COURSES,
+    REGION_COUNT
+};
+
+struct MemStats {
+    size_t allocs;
+    size_t bytesAllocated;
+    size_t inclAllocs;
+    size_t inclBytes;
+    size_t frees;
+    size_t liveBytes;
+    size_t peakLiveBytes;   // peak of this region's own live bytes
+    size_t heapPeakInPhase; // peak of total live heap while the region was active
+};
+
+static MemStats memStats[REGION_COUNT];
+static int activeDepth[REGION_COUNT] = { 1 };
+static MemRegion currentRegion = REGION_PROGRAM;
+static size_t heapLiveBytes = 0;
+static size_t heapPeakBytes = 0;
+
+// Header stored in front of every block so frees know their size and owner
+union MemHeader {
+    struct {
+        size_t size;
+        MemRegion region;
+    } info;
+    max_align_t align;
+};
+
+static void* profiledAlloc(size_t size) {
+    MemHeader* header = static_cast<MemHeader*>(malloc(sizeof(MemHeader) + size));
+    if (!header) throw bad_alloc();
+    header->info.size = size;
+    header->info.region = currentRegion;
+
+    MemStats& stats = memStats[currentRegion];
+    stats.allocs++;
+    stats.bytesAllocated += size;
+    stats.liveBytes += size;
+    if (stats.liveBytes > stats.peakLiveBytes) stats.peakLiveBytes = stats.liveBytes;
+
+    heapLiveBytes += size;
+    if (heapLiveBytes > heapPeakBytes) heapPeakBytes = heapLiveBytes;
+    for (int i = 0; i < REGION_COUNT; i++) {
+        if (activeDepth[i] == 0) continue;
+        memStats[i].inclAllocs++;
+        memStats[i].inclBytes += size;
+        if (heapLiveBytes > memStats[i].heapPeakInPhase) memStats[i].heapPeakInPhase = heapLiveBytes;
+    }
+    return header + 1;
+}
+
+static void profiledFree(void* ptr) {
+    if (!ptr) return;
+    MemHeader* header = static_cast<MemHeader*>(ptr) - 1;
+    MemStats& stats = memStats[header->info.region];
+    stats.frees++;
+    stats.liveBytes -= header->info.size;
+    heapLiveBytes -= header->info.size;
+    free(header);
+}
+
+void* operator new(size_t size) { return profiledAlloc(size); }
+void* operator new[](size_t size) { return profiledAlloc(size); }
+void operator delete(void* ptr) noexcept { profiledFree(ptr); }
+void operator delete[](void* ptr) noexcept { profiledFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { profiledFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { profiledFree(ptr); }
+
+// RAII guard that makes a region current for the enclosing scope
+class ScopedMemRegion {
+private:
+    MemRegion region;
+    MemRegion previous;
+
+public:
+    ScopedMemRegion(MemRegion r) : region(r), previous(currentRegion) {
+        // The heap already in use when a phase starts counts towards its peak
+        if (heapLiveBytes > memStats[region].heapPeakInPhase) memStats[region].heapPeakInPhase = heapLiveBytes;
+        activeDepth[region]++;
+        currentRegion = region;
+    }
+    ~ScopedMemRegion() {
+        activeDepth[region]--;
+        currentRegion = previous;
+    }
+    ScopedMemRegion(const ScopedMemRegion&) = delete;
+    ScopedMemRegion& operator=(const ScopedMemRegion&) = delete;
+};
+
+#define MEM_REGION(region) ScopedMemRegion memRegionGuard(region)
+
+// Function to print the per-region allocation table
+void printMemoryReport(const char* title) {
+    static const char* const regionNames[REGION_COUNT] = {
+        "program", "load students", "load instructors", "load courses", "menus",
+        "getters", "grades/gpa", "save students", "save instructors", "save courses"
+    };
+
+    // Snapshot first so the report's own output does not skew the numbers
+    MemStats snapshot[REGION_COUNT];
+    for (int i = 0; i < REGION_COUNT; i++) snapshot[i] = memStats[i];
+    size_t live = heapLiveBytes;
+    size_t peak = heapPeakBytes;
+
+    cout << endl << "**** Memory Profile (" << title << ") ****" << endl;
+    cout << left << setw(18) << "Region" << right
+         << setw(8) << "Allocs" << setw(10) << "Bytes"
+         << setw(12) << "Incl allocs" << setw(12) << "Incl bytes"
+         << setw(8) << "Frees" << setw(10) << "Live"
+         << setw(11) << "Peak live" << setw(11) << "Heap peak" << endl;
+    for (int i = 0; i < REGION_COUNT; i++) {
+        const MemStats& s = snapshot[i];
+        cout << left << setw(18) << regionNames[i] << right
+             << setw(8) << s.allocs << setw(10) << s.bytesAllocated
+             << setw(12) << s.inclAllocs << setw(12) << s.inclBytes
+             << setw(8) << s.frees << setw(10) << s.liveBytes
+             << setw(11) << s.peakLiveBytes << setw(11) << s.heapPeakInPhase << endl;
+    }
+    cout << "Heap in use: " << live << " bytes, overall peak: " << peak << " bytes" << endl;
+}
+
+void printExitMemoryReport() {
+    printMemoryReport("at exit");
+}
+#else
+#define MEM_REGION(region) ((void)0)
+#endif
+
 class Course;
 class Grade;
 
@@ -23,29 +178,29 @@ public:
     Person(string n, int i, string pwd) : name(n), id(i), password(pwd) {}
     virtual ~Person() {}
 
-    string getName() const { return name; }
+    string getName() const { MEM_REGION(REGION_GETTERS); return name; }
     int getId() const { return id; }
     bool checkPassword(const string& pwd) const { return password == pwd; }
     void setPassword(const string& pwd) { password = pwd; }
-    string getPassword() const { return password; }
+    string getPassword() const { MEM_REGION(REGION_GETTERS); return password; }
 };
 
 // Grade class
 class Grade {
 private:
-    Course* course;
+    string courseCode;  // Code rather than Course* so adding or removing courses cannot leave it dangling
     char grade;
     int marks;
 
 public:
-    Grade(Course* c, char g, int m) : course(c), grade(g), marks(m) {}
+    Grade(string code, char g, int m) : courseCode(code), grade(g), marks(m) {}
 
-    Course* getCourse() const;
+    string getCourseCode() const { MEM_REGION(REGION_GETTERS); return courseCode; }
     char getGrade() const { return grade; }
     int getMarks() const { return marks; }
 
     void save(ofstream& out) const;
-    static Grade load(ifstream& in, const vector<Course>& courses);
+    static Grade load(ifstream& in);
 };
 
 // Forward declaration of Student and Course classes
@@ -66,9 +221,9 @@ public:
     void enrollStudent(Student* student);
     void assignInstructor(Instructor* instr);
 
-    string getCourseName() const { return courseName; }
-    string getCourseCode() const { return courseCode; }
-    vector<Student*> getStudents() const { return students; }
+    string getCourseName() const { MEM_REGION(REGION_GETTERS); return courseName; }
+    string getCourseCode() const { MEM_REGION(REGION_GETTERS); return courseCode; }
+    vector<Student*> getStudents() const { MEM_REGION(REGION_GETTERS); return students; }
     Instructor* getInstructor() const { return instructor; }
 };
 
@@ -83,8 +238,8 @@ public:
 
     void enrollCourse(Course* course);
     void addGrade(const Grade& grade);
-    vector<Grade> getGrades() const { return grades; }
-    vector<Course*> getEnrolledCourses() const { return enrolledCourses; }
+    vector<Grade> getGrades() const { MEM_REGION(REGION_GETTERS); return grades; }
+    vector<Course*> getEnrolledCourses() const { MEM_REGION(REGION_GETTERS); return enrolledCourses; }
 
     double getGPA() const;
 
@@ -104,34 +259,25 @@ public:
     void assignCourse(Course* course);
     void addGradeToStudent(Student* student, Course* course, char grade, int marks);
 
-    string getDepartment() const { return department; }
-    vector<Course*> getAssignedCourses() const { return assignedCourses; }
+    string getDepartment() const { MEM_REGION(REGION_GETTERS); return department; }
+    vector<Course*> getAssignedCourses() const { MEM_REGION(REGION_GETTERS); return assignedCourses; }
 };
 
 // Method implementations for Grade class
-Course* Grade::getCourse() const {
-    return course;
-}
-
 void Grade::save(ofstream& out) const {
-    out << course->getCourseCode() << " " << grade << " " << marks << endl;
+    out << courseCode << " " << grade << " " << marks << endl;
 }
 
-Grade Grade::load(ifstream& in, const vector<Course>& courses) {
+// A grade record is "<code> <A-F> <marks>"; a student record never matches
+// because its second token is a numeric id
+Grade Grade::load(ifstream& in) {
     string courseCode;
     char grade;
     int marks;
-    in >> courseCode >> grade >> marks;
-
-    auto it = find_if(courses.begin(), courses.end(), [&courseCode](const Course& c) {
-        return c.getCourseCode() == courseCode;
-    });
-
-    // if (it != courses.end()) {
-    //     return Grade(&(*it), grade, marks);
-    // } else {
-    //     throw runtime_error("Course not found during grade loading.");
-    // }
+    if (!(in >> courseCode >> grade >> marks) || grade < 'A' || grade > 'F') {
+        throw runtime_error("Not a grade record.");
+    }
+    return Grade(courseCode, grade, marks);
 }
 
 // Method implementations for Student class
@@ -165,9 +311,21 @@ void Student::saveGrades(ofstream& out) const {
 
 void Student::loadGrades(ifstream& in, const vector<Course>& courses) {
     while (in) {
+        streampos start = in.tellg();
         try {
-            grades.push_back(Grade::load(in, courses));
+            Grade grade = Grade::load(in);
+            auto it = find_if(courses.begin(), courses.end(), [&grade](const Course& c) {
+                return c.getCourseCode() == grade.getCourseCode();
+            });
+            if (it == courses.end()) {
+                cerr << "Warning: skipping grade for unknown course " << grade.getCourseCode() << " (student " << id << ")" << endl;
+                continue;
+            }
+            grades.push_back(grade);
         } catch (const runtime_error& e) {
+            // Not a grade line, rewind so the next student record can be read
+            in.clear();
+            in.seekg(start);
             break;
         }
     }
@@ -179,7 +337,7 @@ void Instructor::assignCourse(Course* course) {
 }
 
 void Instructor::addGradeToStudent(Student* student, Course* course, char grade, int marks) {
-    Grade newGrade(course, grade, marks);
+    Grade newGrade(course->getCourseCode(), grade, marks);
     student->addGrade(newGrade);
 }
 
@@ -211,9 +369,9 @@ private:
 
 public:
     University(string n) : name(n) {
+        loadCourses();  // Courses first so student grades can resolve their course codes
         loadStudents();
         loadInstructors();
-        loadCourses();
     }
 
     ~University() {
@@ -239,6 +397,7 @@ public:
 
 // University class methods for loading and saving data
 void University::loadStudents() {
+    MEM_REGION(REGION_LOAD_STUDENTS);
     ifstream file("students.txt");
     if (!file) return;
     string name, password;
@@ -251,6 +410,7 @@ void University::loadStudents() {
 }
 
 void University::loadInstructors() {
+    MEM_REGION(REGION_LOAD_INSTRUCTORS);
     ifstream file("instructors.txt");
     if (!file) return;
     string name, password, department;
@@ -261,6 +421,7 @@ void University::loadInstructors() {
 }
 
 void University::loadCourses() {
+    MEM_REGION(REGION_LOAD_COURSES);
     ifstream file("courses.txt");
     if (!file) return;
     string name, code;
@@ -270,6 +431,7 @@ void University::loadCourses() {
 }
 
 void University::saveStudents() {
+    MEM_REGION(REGION_SAVE_STUDENTS);
     ofstream file("students.txt");
     for (const Student& student : students) {
         file << student.getName() << " " << student.getId() << " " << student.getPassword() << endl;
@@ -278,6 +440,7 @@ void University::saveStudents() {
 }
 
 void University::saveInstructors() {
+    MEM_REGION(REGION_SAVE_INSTRUCTORS);
     ofstream file("instructors.txt");
     for (const Instructor& instructor : instructors) {
         file << instructor.getName() << " " << instructor.getId() << " " << instructor.getDepartment() << " " << instructor.getPassword() << endl;
@@ -285,6 +448,7 @@ void University::saveInstructors() {
 }
 
 void University::saveCourses() {
+    MEM_REGION(REGION_SAVE_COURSES);
     ofstream file("courses.txt");
     for (const Course& course : courses) {
         file << course.getCourseName() << " " << course.getCourseCode() << endl;
@@ -365,6 +529,7 @@ string getPassword() {
 
 // Admin menu function
 void adminMenu(University& university) {
+    MEM_REGION(REGION_MENUS);
     int choice;
     do {
         cout << endl << "\t\t\t\t\t\t**** Admin Menu ****" << endl;
@@ -461,7 +626,8 @@ void adminMenu(University& university) {
 }
 
 // Student menu function
-void studentMenu(Student* student) {
+void studentMenu(Student* student, University& university) {
+    MEM_REGION(REGION_MENUS);
     int choice;
     do {
         cout << endl << "\t\t\t\t\t\t**** Student Menu ****" << endl;
@@ -483,13 +649,16 @@ void studentMenu(Student* student) {
                     break;
                 }
                 case 2: {
+                    MEM_REGION(REGION_GRADES);
                     cout << "Grades:" << endl;
                     for (const Grade& grade : student->getGrades()) {
-                        cout << grade.getCourse()->getCourseName() << ": " << grade.getGrade() << " (" << grade.getMarks() << " marks)" << endl;
+                        Course* course = university.findCourseByCode(grade.getCourseCode());
+                        cout << (course ? course->getCourseName() : grade.getCourseCode()) << ": " << grade.getGrade() << " (" << grade.getMarks() << " marks)" << endl;
                     }
                     break;
                 }
                 case 3: {
+                    MEM_REGION(REGION_GRADES);
                     cout << "GPA: " << student->getGPA() << endl;
                     break;
                 }
@@ -510,6 +679,7 @@ void studentMenu(Student* student) {
 
 // Instructor menu function
 void instructorMenu(Instructor* instructor, University& university) {
+    MEM_REGION(REGION_MENUS);
     int choice;
     do {
         cout << endl << "\t\t\t\t\t\t**** Instructor Menu ****" << endl;
@@ -581,6 +751,7 @@ void instructorMenu(Instructor* instructor, University& university) {
 
 // Login menu function
 void loginMenu(University& university) {
+    MEM_REGION(REGION_MENUS);
     int choice;
     do {
         cout << endl << "\t\t\t\t\t\t**** University Management System ****" << endl;
@@ -613,7 +784,7 @@ void loginMenu(University& university) {
                     if (student) {
                         string inputPassword = getPassword();
                         if (student->checkPassword(inputPassword)) {
-                            studentMenu(student);
+                            studentMenu(student, university);
                         } else {
                             cout << "Incorrect password. Access denied." << endl;
                         }
@@ -656,7 +827,15 @@ void loginMenu(University& university) {
 }
 
 int main() {
+#ifdef MEMORY_PROFILE
+    // Runs after university is destroyed, so the save phase is included
+    atexit(printExitMemoryReport);
+#endif
     University university("KLETECH");
+#ifdef MEMORY_PROFILE
+    // Live bytes here are what the loaded University keeps resident
+    printMemoryReport("after load");
+#endif
     loginMenu(university);
     return 0;
 }